@@ -0,0 +1,133 @@
+import { CModule } from './cmodule';
+import { BlockRangeProofVerifier, Secp256k1ZKP } from './interface';
+import Memory from './memory';
+
+function verifyTransaction(
+  cModule: CModule
+): Secp256k1ZKP['elements']['verifyTransaction'] {
+  return function elementsVerifyTransaction(
+    tx: Uint8Array,
+    inputGenerators: Uint8Array[]
+  ) {
+    if (!tx || !(tx instanceof Uint8Array) || !tx.length)
+      throw new TypeError('tx must be a non-empty Uint8Array');
+    if (
+      !inputGenerators ||
+      !Array.isArray(inputGenerators) ||
+      !inputGenerators.every((g) => g.length === 33)
+    )
+      throw new TypeError(
+        'input generators must be an array of Uint8Arrays of 33 bytes'
+      );
+
+    const memory = new Memory(cModule);
+
+    // the transaction is copied once into the heap and parsed in place
+    const txPtr = memory.malloc(tx.length);
+    cModule.HEAPU8.set(tx, txPtr);
+    const ret = cModule.ccall(
+      'elements_tx_verify',
+      'number',
+      ['number', 'number', 'number', 'number'],
+      [
+        txPtr,
+        tx.length,
+        memory.charStarArray(inputGenerators),
+        inputGenerators.length,
+      ]
+    );
+    memory.free();
+    return ret === 1;
+  };
+}
+
+function blockRangeProofVerifier(
+  cModule: CModule
+): Secp256k1ZKP['elements']['blockRangeProofVerifier'] {
+  return function elementsBlockRangeProofVerifier(): BlockRangeProofVerifier {
+    const verifier = cModule.ccall(
+      'elements_block_rangeproof_verifier_create',
+      'number',
+      [],
+      []
+    );
+    if (verifier === 0)
+      throw new RangeError('elements_block_rangeproof_verifier_create');
+
+    // the C verifier is released as soon as the outcome is known, so a
+    // verifier dropped after an invalid chunk doesn't hold on to its buffer
+    let state: 'open' | 'invalid' | 'released' = 'open';
+
+    function destroy(): void {
+      if (state === 'open')
+        cModule.ccall(
+          'elements_block_rangeproof_verifier_destroy',
+          null,
+          ['number'],
+          [verifier]
+        );
+      if (state !== 'invalid') state = 'released';
+    }
+
+    function invalidate(): false {
+      destroy();
+      state = 'invalid';
+      return false;
+    }
+
+    return {
+      update(chunk: Uint8Array) {
+        if (!chunk || !(chunk instanceof Uint8Array))
+          throw new TypeError('chunk must be a Uint8Array');
+        if (state === 'invalid') return false;
+        if (state === 'released')
+          throw new Error('block verifier already released');
+
+        // chunks are written straight into the verifier buffer
+        const ptr = cModule.ccall(
+          'elements_block_rangeproof_verifier_reserve',
+          'number',
+          ['number', 'number'],
+          [verifier, chunk.length]
+        );
+        if (ptr === 0) {
+          destroy();
+          throw new RangeError(
+            `elements_block_rangeproof_verifier_reserve: unable to buffer ${chunk.length} bytes`
+          );
+        }
+        cModule.HEAPU8.set(chunk, ptr);
+
+        const ret = cModule.ccall(
+          'elements_block_rangeproof_verifier_commit',
+          'number',
+          ['number', 'number'],
+          [verifier, chunk.length]
+        );
+        return ret === 1 || invalidate();
+      },
+      finalize() {
+        if (state === 'invalid') return false;
+        if (state === 'released')
+          throw new Error('block verifier already released');
+
+        const ret = cModule.ccall(
+          'elements_block_rangeproof_verifier_finish',
+          'number',
+          ['number'],
+          [verifier]
+        );
+        destroy();
+        return ret === 1;
+      },
+      destroy,
+    };
+  };
+}
+
+export function elements(cModule: CModule): Secp256k1ZKP['elements'] {
+  return {
+    verifyTransaction: verifyTransaction(cModule),
+    blockRangeProofVerifier: blockRangeProofVerifier(cModule),
+  };
+}
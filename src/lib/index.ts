@@ -1,6 +1,7 @@
 import { loadSecp256k1ZKP } from './cmodule';
 import { ecc } from './ecc';
 import { ecdh } from './ecdh';
+import { elements } from './elements';
 import { generator } from './generator';
 import { Secp256k1ZKP } from './interface';
 import { musig } from './musig';
@@ -18,5 +19,6 @@ export const secp256k1Function = async (): Promise<Secp256k1ZKP> => {
     generator: generator(cModule),
     rangeproof: rangeproof(cModule),
     surjectionproof: surjectionproof(cModule),
+    elements: elements(cModule),
   };
 };
@@ -173,6 +173,31 @@ export interface Musig {
   };
 }
 
+export interface BlockRangeProofVerifier {
+  // returns false as soon as the block is known to be invalid, the verifier
+  // is then released and every later update returns false
+  update(chunk: Uint8Array): boolean;
+  // returns true if a complete block with valid rangeproofs was received,
+  // and releases the verifier
+  finalize(): boolean;
+  // releases the verifier without finalizing it
+  destroy(): void;
+}
+
+// Transactions with a blinded issuance (committed issuance amount or inflation
+// keys) are reported invalid: their rangeproofs are not supported.
+export interface Elements {
+  // input generators are the assets of the spent outputs, they can be empty if
+  // every output asset is explicit
+  verifyTransaction(
+    tx: Uint8Array,
+    inputGenerators: Array<Uint8Array>
+  ): boolean;
+  // only rangeproofs are verified, surjection proofs need the assets of the
+  // spent outputs
+  blockRangeProofVerifier(): BlockRangeProofVerifier;
+}
+
 export interface Secp256k1ZKP {
   ecdh: Ecdh;
   ecc: Ecc;
@@ -181,4 +206,5 @@ export interface Secp256k1ZKP {
   rangeproof: RangeProof;
   pedersen: Pedersen;
   generator: Generator;
+  elements: Elements;
 }
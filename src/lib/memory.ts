@@ -22,6 +22,12 @@ export default class Memory implements MemoryI {
 
   malloc(size: number): number {
     const ret = this.cModule._malloc(size);
+    if (ret === 0) {
+      // the heap is exhausted (or bounded): release what was allocated so far
+      // and fail instead of handing out a null pointer
+      this.free();
+      throw new RangeError(`malloc: unable to allocate ${size} bytes`);
+    }
     this.toFree.push(ret);
     return ret;
   }
@@ -15,67 +15,108 @@
 #define SECP256K1_CONTEXT_ALL SECP256K1_CONTEXT_NONE | SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY
 #endif
 
+#ifdef BOUNDED_MEMORY
+// the heap can't grow in bounded builds: allocate a single context when the
+// module is instantiated and share it across calls instead of creating one
+// per call
+static secp256k1_context *shared_ctx = NULL;
+
+__attribute__((constructor)) static void context_preallocate(void)
+{
+  void *prealloc = malloc(secp256k1_context_preallocated_size(SECP256K1_CONTEXT_ALL));
+  // every call relies on the shared context: fail the instantiation rather
+  // than handing a NULL context to libsecp256k1 later
+  if (prealloc == NULL)
+  {
+    abort();
+  }
+  shared_ctx = secp256k1_context_preallocated_create(prealloc, SECP256K1_CONTEXT_ALL);
+}
+#endif
+
+static secp256k1_context *context_acquire(unsigned int flags)
+{
+#ifdef BOUNDED_MEMORY
+  (void)flags;
+  return shared_ctx;
+#else
+  return secp256k1_context_create(flags);
+#endif
+}
+
+static void context_release(secp256k1_context *ctx)
+{
+#ifdef BOUNDED_MEMORY
+  (void)ctx;
+#else
+  secp256k1_context_destroy(ctx);
+#endif
+}
+
 int ecdh(unsigned char *output, const unsigned char *pubkey, const unsigned char *scalar)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   secp256k1_pubkey point;
   if (!secp256k1_ec_pubkey_parse(ctx, &point, pubkey, 33))
+  {
+    context_release(ctx);
     return 0;
+  }
   int ret = secp256k1_ecdh(ctx, output, &point, scalar, NULL, NULL);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int generator_generate(unsigned char *output, const unsigned char *random_seed32)
 {
   secp256k1_generator gen;
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   int ret = secp256k1_generator_generate(ctx, &gen, random_seed32);
   if (!ret)
   {
-    secp256k1_context_destroy(ctx);
+    context_release(ctx);
     return ret;
   }
 
   ret = secp256k1_generator_serialize(ctx, output, &gen);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int generator_generate_blinded(unsigned char *output, const unsigned char *key, const unsigned char *blinder)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   secp256k1_generator gen;
   int ret = secp256k1_generator_generate_blinded(ctx, &gen, key, blinder);
   if (!ret)
   {
-    secp256k1_context_destroy(ctx);
+    context_release(ctx);
     return ret;
   }
 
   ret = secp256k1_generator_serialize(ctx, output, &gen);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int pedersen_blind_generator_blind_sum(const uint64_t *values, const unsigned char *const *generator_blinds, unsigned char **blind_factors, size_t n_total, size_t n_inputs, unsigned char *bytes_out)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   blind_factors[n_total - 1] = bytes_out;
   int ret = secp256k1_pedersen_blind_generator_blind_sum(ctx, values, generator_blinds, (unsigned char *const *)blind_factors, n_total, n_inputs);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int pedersen_commitment(unsigned char *output, uint64_t *value, const unsigned char *generator, const unsigned char *blinder)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   secp256k1_generator gen;
 
   int ret = secp256k1_generator_parse(ctx, &gen, generator);
   if (!ret)
   {
-    secp256k1_context_destroy(ctx);
+    context_release(ctx);
     return ret;
   }
 
@@ -83,12 +124,12 @@ int pedersen_commitment(unsigned char *output, uint64_t *value, const unsigned c
   ret = secp256k1_pedersen_commit(ctx, &commit, blinder, *value, &gen);
   if (!ret)
   {
-    secp256k1_context_destroy(ctx);
+    context_release(ctx);
     return ret;
   }
 
   ret = secp256k1_pedersen_commitment_serialize(ctx, output, &commit);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
@@ -108,12 +149,12 @@ int rangeproof_sign(
     const unsigned char *extra_commit,
     size_t extra_commit_len)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   secp256k1_pedersen_commitment commit;
   int ret = secp256k1_pedersen_commitment_parse(ctx, &commit, commit_data);
   if (!ret)
   {
-    secp256k1_context_destroy(ctx);
+    context_release(ctx);
     return ret;
   }
 
@@ -121,31 +162,31 @@ int rangeproof_sign(
   ret = secp256k1_generator_parse(ctx, &gen, generator_data);
   if (!ret)
   {
-    secp256k1_context_destroy(ctx);
+    context_release(ctx);
     return ret;
   }
 
   ret = secp256k1_rangeproof_sign(ctx, proof, plen, *min_value, &commit, blind, nonce, exp, min_bits, *value, msg_len > 0 ? message : NULL, msg_len, extra_commit_len > 0 ? extra_commit : NULL, extra_commit_len, &gen);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int rangeproof_info(int *exp, int *mantissa, uint64_t *min_value, uint64_t *max_value, const unsigned char *proof, size_t plen)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   int ret = secp256k1_rangeproof_info(ctx, exp, mantissa, min_value, max_value, proof, plen);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int rangeproof_verify(uint64_t *min_value, uint64_t *max_value, const unsigned char *proof, size_t plen, const unsigned char *commit_data, const unsigned char *generator_data, const unsigned char *extra_commit, size_t extra_commit_len)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   secp256k1_pedersen_commitment commit;
   int ret = secp256k1_pedersen_commitment_parse(ctx, &commit, commit_data);
   if (!ret)
   {
-    secp256k1_context_destroy(ctx);
+    context_release(ctx);
     return ret;
   }
 
@@ -153,23 +194,23 @@ int rangeproof_verify(uint64_t *min_value, uint64_t *max_value, const unsigned c
   ret = secp256k1_generator_parse(ctx, &gen, generator_data);
   if (!ret)
   {
-    secp256k1_context_destroy(ctx);
+    context_release(ctx);
     return ret;
   }
 
   ret = secp256k1_rangeproof_verify(ctx, min_value, max_value, &commit, proof, plen, extra_commit, extra_commit_len, &gen);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int rangeproof_rewind(unsigned char *blind_out, uint64_t *value_out, uint64_t *min_value, uint64_t *max_value, unsigned char *message_out, size_t *outlen, const unsigned char *proof, size_t plen, const unsigned char *commit_data, const unsigned char *generator_data, const unsigned char *nonce, const unsigned char *extra_commit, size_t extra_commit_len)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   secp256k1_pedersen_commitment commit;
   int ret = secp256k1_pedersen_commitment_parse(ctx, &commit, commit_data);
   if (!ret)
   {
-    secp256k1_context_destroy(ctx);
+    context_release(ctx);
     return ret;
   }
 
@@ -177,18 +218,22 @@ int rangeproof_rewind(unsigned char *blind_out, uint64_t *value_out, uint64_t *m
   ret = secp256k1_generator_parse(ctx, &gen, generator_data);
   if (!ret)
   {
-    secp256k1_context_destroy(ctx);
+    context_release(ctx);
     return ret;
   }
 
   ret = secp256k1_rangeproof_rewind(ctx, blind_out, value_out, message_out, outlen, nonce, min_value, max_value, &commit, proof, plen, extra_commit, extra_commit_len, &gen);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int surjectionproof_initialize(unsigned char *output, size_t *outputlen, size_t *input_index, const unsigned char *const *input_tags_data, const size_t n_input_tags, const size_t n_input_tags_to_use, const unsigned char *output_tag_data, const size_t n_max_iterations, const unsigned char *random_seed32)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  // input tags are copied to the stack, reject oversized sets before they can overflow it
+  if (n_input_tags > SECP256K1_SURJECTIONPROOF_MAX_N_INPUTS)
+    return 0;
+
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   secp256k1_fixed_asset_tag input_tags[n_input_tags];
   for (int i = 0; i < (int)n_input_tags; ++i)
   {
@@ -202,23 +247,26 @@ int surjectionproof_initialize(unsigned char *output, size_t *outputlen, size_t
   int ret = secp256k1_surjectionproof_initialize(ctx, &proof, input_index, input_tags, n_input_tags, n_input_tags_to_use, &output_tag, n_max_iterations, random_seed32);
   if (!ret)
   {
-    secp256k1_context_destroy(ctx);
+    context_release(ctx);
     return ret;
   }
 
   ret = secp256k1_surjectionproof_serialize(ctx, output, outputlen, &proof);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int surjectionproof_generate(unsigned char *output, size_t *outputlen, const unsigned char *proof_data, const size_t proof_len, const unsigned char *const *ephemeral_input_tags_data, const size_t n_ephemeral_input_tags, const unsigned char *ephemeral_output_tag_data, size_t input_index, const unsigned char *input_blinding_key, const unsigned char *output_blinding_key)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  if (n_ephemeral_input_tags > SECP256K1_SURJECTIONPROOF_MAX_N_INPUTS)
+    return 0;
+
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   secp256k1_surjectionproof proof;
   int ret = secp256k1_surjectionproof_parse(ctx, &proof, proof_data, proof_len);
   if (!ret)
   {
-    secp256k1_context_destroy(ctx);
+    context_release(ctx);
     return ret;
   }
 
@@ -228,7 +276,7 @@ int surjectionproof_generate(unsigned char *output, size_t *outputlen, const uns
     int ret = secp256k1_generator_parse(ctx, &ephemeral_input_tags[i], ephemeral_input_tags_data[i]);
     if (!ret)
     {
-      secp256k1_context_destroy(ctx);
+      context_release(ctx);
       return ret;
     }
   }
@@ -236,30 +284,33 @@ int surjectionproof_generate(unsigned char *output, size_t *outputlen, const uns
   ret = secp256k1_generator_parse(ctx, &ephemeral_output_tag, ephemeral_output_tag_data);
   if (!ret)
   {
-    secp256k1_context_destroy(ctx);
+    context_release(ctx);
     return ret;
   }
 
   ret = secp256k1_surjectionproof_generate(ctx, &proof, ephemeral_input_tags, n_ephemeral_input_tags, &ephemeral_output_tag, input_index, input_blinding_key, output_blinding_key);
   if (!ret)
   {
-    secp256k1_context_destroy(ctx);
+    context_release(ctx);
     return ret;
   }
 
   ret = secp256k1_surjectionproof_serialize(ctx, output, outputlen, &proof);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int surjectionproof_verify(const unsigned char *proof_data, const size_t proof_len, const unsigned char *const *ephemeral_input_tags_data, const size_t n_ephemeral_input_tags, const unsigned char *ephemeral_output_tag_data)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+  if (n_ephemeral_input_tags > SECP256K1_SURJECTIONPROOF_MAX_N_INPUTS)
+    return 0;
+
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_VERIFY);
   secp256k1_surjectionproof proof;
   int ret = secp256k1_surjectionproof_parse(ctx, &proof, proof_data, proof_len);
   if (!ret)
   {
-    secp256k1_context_destroy(ctx);
+    context_release(ctx);
     return ret;
   }
 
@@ -269,7 +320,7 @@ int surjectionproof_verify(const unsigned char *proof_data, const size_t proof_l
     int ret = secp256k1_generator_parse(ctx, &ephemeral_input_tags[i], ephemeral_input_tags_data[i]);
     if (!ret)
     {
-      secp256k1_context_destroy(ctx);
+      context_release(ctx);
       return ret;
     }
   }
@@ -277,68 +328,68 @@ int surjectionproof_verify(const unsigned char *proof_data, const size_t proof_l
   ret = secp256k1_generator_parse(ctx, &ephemeral_output_tag, ephemeral_output_tag_data);
   if (!ret)
   {
-    secp256k1_context_destroy(ctx);
+    context_release(ctx);
     return ret;
   }
 
   ret = secp256k1_surjectionproof_verify(ctx, &proof, ephemeral_input_tags, n_ephemeral_input_tags, &ephemeral_output_tag);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int ec_seckey_negate(unsigned char *key)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   int ret = secp256k1_ec_seckey_negate(ctx, key);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int ec_seckey_tweak_add(unsigned char *key, const unsigned char *tweak)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   int ret = secp256k1_ec_seckey_tweak_add(ctx, key, tweak);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int ec_seckey_tweak_mul(unsigned char *key, const unsigned char *tweak)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   int ret = secp256k1_ec_seckey_tweak_mul(ctx, key, tweak);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int ec_seckey_tweak_sub(unsigned char *key, const unsigned char *tweak)
 {
-  unsigned char *t = malloc(32);
+  unsigned char t[32];
   memcpy(t, tweak, 32);
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   int ret = secp256k1_ec_seckey_negate(ctx, t);
   if (ret == 1)
   {
     ret = secp256k1_ec_seckey_tweak_add(ctx, key, (const unsigned char *)t);
   }
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int ec_is_valid_xonly_pubkey(const unsigned char *key)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   secp256k1_xonly_pubkey pubkey;
   int ret = secp256k1_xonly_pubkey_parse(ctx, &pubkey, key);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int ec_is_valid_pubkey(const unsigned char *key, size_t key_len)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   secp256k1_pubkey pubkey;
   int ret = secp256k1_ec_pubkey_parse(ctx, &pubkey, key, key_len);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
@@ -354,33 +405,33 @@ int ec_is_point(const unsigned char *key, size_t key_len)
 
 int ec_point_compress(unsigned char *output, size_t *output_len, const unsigned char *point, size_t point_len, int compress)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   secp256k1_pubkey pubkey;
   int ret = secp256k1_ec_pubkey_parse(ctx, &pubkey, point, point_len);
   if (ret == 1)
   {
     ret = secp256k1_ec_pubkey_serialize(ctx, output, output_len, &pubkey, compress ? SECP256K1_EC_COMPRESSED : SECP256K1_EC_UNCOMPRESSED);
   }
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int ec_point_from_scalar(unsigned char *output, size_t *output_len, const unsigned char *scalar, int compress)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   secp256k1_pubkey pubkey;
   int ret = secp256k1_ec_pubkey_create(ctx, &pubkey, scalar);
   if (ret == 1)
   {
     ret = secp256k1_ec_pubkey_serialize(ctx, output, output_len, &pubkey, compress ? SECP256K1_EC_COMPRESSED : SECP256K1_EC_UNCOMPRESSED);
   }
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int ec_x_only_point_tweak_add(unsigned char *output, int *parity, const unsigned char *point, const unsigned char *tweak)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   secp256k1_xonly_pubkey pubkey;
   secp256k1_pubkey pubkey_result;
   int ret = secp256k1_xonly_pubkey_parse(ctx, &pubkey, point);
@@ -396,26 +447,26 @@ int ec_x_only_point_tweak_add(unsigned char *output, int *parity, const unsigned
       }
     }
   }
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int ec_sign_ecdsa(unsigned char *output, const unsigned char *d, const unsigned char *h, int withextradata, const unsigned char *e)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_SIGN);
   secp256k1_ecdsa_signature sig;
   int ret = secp256k1_ecdsa_sign(ctx, &sig, h, d, secp256k1_nonce_function_rfc6979, withextradata ? e : NULL);
   if (ret == 1)
   {
     ret = secp256k1_ecdsa_signature_serialize_compact(ctx, output, &sig);
   }
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int ec_verify_ecdsa(const unsigned char *q, size_t q_len, const unsigned char *h, const unsigned char *sig, const int strict)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_VERIFY);
   secp256k1_ecdsa_signature sig_parsed;
   secp256k1_pubkey pubkey;
   int ret = secp256k1_ec_pubkey_parse(ctx, &pubkey, q, q_len);
@@ -431,41 +482,41 @@ int ec_verify_ecdsa(const unsigned char *q, size_t q_len, const unsigned char *h
       ret = secp256k1_ecdsa_verify(ctx, &sig_parsed, h, &pubkey);
     }
   }
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int ec_sign_schnorr(unsigned char *output, const unsigned char *d, const unsigned char *h, const int withextradata, const unsigned char *e)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_SIGN);
   secp256k1_keypair key;
   int ret = secp256k1_keypair_create(ctx, &key, d);
   if (ret == 1)
   {
     ret = secp256k1_schnorrsig_sign32(ctx, output, h, &key, withextradata ? e : NULL);
   }
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int ec_verify_schnorr(const unsigned char *q, const unsigned char *h, size_t h_len, const unsigned char *sig)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_VERIFY);
   secp256k1_xonly_pubkey pubkey;
   int ret = secp256k1_xonly_pubkey_parse(ctx, &pubkey, q);
   if (ret == 1)
   {
     ret = secp256k1_schnorrsig_verify(ctx, sig, h, h_len, &pubkey);
   }
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int ec_seckey_verify(const unsigned char *seckey)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_VERIFY);
   int ret = secp256k1_ec_seckey_verify(ctx, seckey);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
@@ -483,7 +534,7 @@ int isZero(const unsigned char *array, size_t size)
 
 int ec_point_add_scalar(unsigned char *output, size_t *output_len, const unsigned char *point, const unsigned char *tweak, int compress)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_ALL);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_ALL);
   secp256k1_pubkey pubkey;
   int ret = secp256k1_ec_pubkey_parse(ctx, &pubkey, point, 33);
   if (ret == 1)
@@ -504,34 +555,45 @@ int ec_point_add_scalar(unsigned char *output, size_t *output_len, const unsigne
       }
     }
   }
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
-void **alloc_pointer_arr(size_t n, size_t elem_size)
+void free_pointer_arr(void **ptrs, size_t n)
 {
-  void **arr = malloc(sizeof(void *) * n);
   for (int i = 0; i < n; i++)
   {
-    arr[i] = malloc(elem_size);
+    free(ptrs[i]);
   }
-  return arr;
+  free(ptrs);
 }
 
-void free_pointer_arr(void **ptrs, size_t n)
+// returns NULL if any allocation fails, so that an oversized batch is
+// rejected instead of aborting when the heap is bounded
+void **alloc_pointer_arr(size_t n, size_t elem_size)
 {
+  void **arr = malloc(sizeof(void *) * n);
+  if (arr == NULL)
+  {
+    return NULL;
+  }
   for (int i = 0; i < n; i++)
   {
-    free(ptrs[i]);
+    arr[i] = malloc(elem_size);
+    if (arr[i] == NULL)
+    {
+      free_pointer_arr(arr, i);
+      return NULL;
+    }
   }
-  free(ptrs);
+  return arr;
 }
 
-#define RETURN_ON_ZERO              \
-  if (ret == 0)                     \
-  {                                 \
-    secp256k1_context_destroy(ctx); \
-    return ret;                     \
+#define RETURN_ON_ZERO    \
+  if (ret == 0)           \
+  {                       \
+    context_release(ctx); \
+    return ret;           \
   }
 
 int musig_pubkey_agg(
@@ -541,8 +603,13 @@ int musig_pubkey_agg(
   const size_t n_pubkeys,
   const size_t pubkey_len)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_VERIFY);
   secp256k1_pubkey **pubkeys_ptr = (secp256k1_pubkey **)alloc_pointer_arr(n_pubkeys, sizeof(secp256k1_pubkey));
+  if (pubkeys_ptr == NULL)
+  {
+    context_release(ctx);
+    return 0;
+  }
 
   int ret = 1;
   for (int i = 0; i < n_pubkeys && ret == 1; i++)
@@ -562,7 +629,7 @@ int musig_pubkey_agg(
   }
 
   free_pointer_arr((void **)pubkeys_ptr, n_pubkeys);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
@@ -573,7 +640,7 @@ int musig_nonce_gen(
   const unsigned char *pubkey,
   const size_t pubkey_len)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_SIGN);
 
   secp256k1_pubkey pubkey_temp;
   int ret = secp256k1_ec_pubkey_parse(ctx, &pubkey_temp, pubkey, pubkey_len);
@@ -585,14 +652,19 @@ int musig_nonce_gen(
 
   ret = secp256k1_musig_pubnonce_serialize(ctx, pubnonce, &pubnonce_temp);
 
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int musig_nonce_agg(unsigned char *aggnonce, const unsigned char *const *pubnonces, size_t n_pubnonces)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_NONE);
   secp256k1_musig_pubnonce **pubnonces_ptr = (secp256k1_musig_pubnonce **)alloc_pointer_arr(n_pubnonces, sizeof(secp256k1_musig_pubnonce));
+  if (pubnonces_ptr == NULL)
+  {
+    context_release(ctx);
+    return 0;
+  }
 
   int ret = 1;
   for (int i = 0; i < n_pubnonces && ret == 1; i++)
@@ -612,13 +684,13 @@ int musig_nonce_agg(unsigned char *aggnonce, const unsigned char *const *pubnonc
   }
 
   free_pointer_arr((void **)pubnonces_ptr, n_pubnonces);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int musig_nonce_process(secp256k1_musig_session *session, const unsigned char *aggnonce_serialized, const unsigned char *msg32, const secp256k1_musig_keyagg_cache *keyagg_cache)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_VERIFY);
 
   secp256k1_musig_aggnonce aggnonce;
   int ret = secp256k1_musig_aggnonce_parse(ctx, &aggnonce, aggnonce_serialized);
@@ -626,13 +698,13 @@ int musig_nonce_process(secp256k1_musig_session *session, const unsigned char *a
 
   ret = secp256k1_musig_nonce_process(ctx, session, &aggnonce, msg32, keyagg_cache, NULL);
 
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
 int musig_partial_sign(unsigned char *partial_sig, secp256k1_musig_secnonce *secnonce, const unsigned char *seckey, const secp256k1_musig_keyagg_cache *keyagg_cache, const secp256k1_musig_session *session)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_SIGN);
 
   secp256k1_keypair keypair;
   int ret = secp256k1_keypair_create(ctx, &keypair, seckey);
@@ -644,7 +716,7 @@ int musig_partial_sign(unsigned char *partial_sig, secp256k1_musig_secnonce *sec
 
   ret = secp256k1_musig_partial_sig_serialize(ctx, partial_sig, &sig_temp);
 
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
@@ -656,7 +728,7 @@ int musig_partial_sig_verify(
   const secp256k1_musig_keyagg_cache *keyagg_cache,
   const secp256k1_musig_session *session)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_VERIFY);
 
   secp256k1_musig_partial_sig sig_temp;
   int ret = secp256k1_musig_partial_sig_parse(ctx, &sig_temp, partial_sig);
@@ -672,7 +744,7 @@ int musig_partial_sig_verify(
 
   ret = secp256k1_musig_partial_sig_verify(ctx, &sig_temp, &pubnonce_temp, &pubkey_temp, keyagg_cache, session);
 
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
@@ -682,8 +754,13 @@ int musig_partial_sig_agg(
   unsigned char **partial_sigs,
   size_t n_sigs)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_NONE);
   secp256k1_musig_partial_sig **sigs_ptr = (secp256k1_musig_partial_sig **)alloc_pointer_arr(n_sigs, sizeof(secp256k1_musig_partial_sig));
+  if (sigs_ptr == NULL)
+  {
+    context_release(ctx);
+    return 0;
+  }
 
   int ret = 1;
   for (int i = 0; i < n_sigs && ret == 1; i++)
@@ -697,7 +774,7 @@ int musig_partial_sig_agg(
   }
 
   free_pointer_arr((void **)sigs_ptr, n_sigs);
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
   return ret;
 }
 
@@ -708,7 +785,7 @@ int musig_pubkey_xonly_tweak_add(
   secp256k1_musig_keyagg_cache *keyagg_cache,
   const unsigned char *tweak)
 {
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_VERIFY);
 
   secp256k1_pubkey output_temp;
   int ret = secp256k1_musig_pubkey_xonly_tweak_add(ctx, &output_temp, keyagg_cache, tweak);
@@ -716,6 +793,633 @@ int musig_pubkey_xonly_tweak_add(
 
   ret = secp256k1_ec_pubkey_serialize(ctx, output, output_len, &output_temp, compress ? SECP256K1_EC_COMPRESSED : SECP256K1_EC_UNCOMPRESSED);
 
-  secp256k1_context_destroy(ctx);
+  context_release(ctx);
+  return ret;
+}
+
+// Elements transaction and block parsing. Transactions are parsed in place:
+// outputs and their witnesses are located by offset in the serialized bytes
+// and fed to the rangeproof and surjection proof verifiers without copying.
+
+// the reader functions return 1 on success, 0 if the data is invalid and
+// ELEMENTS_NEED_MORE if the data ends before the field being read
+#define ELEMENTS_NEED_MORE -1
+// largest vector or buffered item accepted, same as Elements' MAX_SIZE
+#define ELEMENTS_MAX_SIZE 0x02000000
+#define ELEMENTS_OUTPOINT_ISSUANCE_FLAG 0x80000000
+#define ELEMENTS_DYNAFED_VERSION_FLAG 0x80000000
+
+#define ELEMENTS_TRY(expr)          \
+  do                                \
+  {                                 \
+    int elements_ret_ = (expr);     \
+    if (elements_ret_ != 1)         \
+      return elements_ret_;         \
+  } while (0)
+
+typedef struct
+{
+  const unsigned char *data;
+  size_t len;
+  size_t pos;
+} elements_reader;
+
+typedef struct
+{
+  const unsigned char *asset;
+  size_t asset_len;
+  const unsigned char *value;
+  size_t value_len;
+  const unsigned char *script;
+  size_t script_len;
+} elements_output;
+
+typedef struct
+{
+  size_t n_inputs;
+  size_t n_outputs;
+  // offsets in the reader data of the first output and of its witness
+  size_t outputs_pos;
+  size_t output_witnesses_pos;
+  int has_witness;
+} elements_tx_layout;
+
+static int elements_read(elements_reader *r, size_t n, const unsigned char **out)
+{
+  if (r->len - r->pos < n)
+    return ELEMENTS_NEED_MORE;
+  if (out != NULL)
+    *out = r->data + r->pos;
+  r->pos += n;
+  return 1;
+}
+
+static int elements_read_u32(elements_reader *r, uint32_t *out)
+{
+  const unsigned char *p;
+  ELEMENTS_TRY(elements_read(r, 4, &p));
+  if (out != NULL)
+    *out = (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+  return 1;
+}
+
+static int elements_read_varint(elements_reader *r, uint64_t *out)
+{
+  const unsigned char *p;
+  ELEMENTS_TRY(elements_read(r, 1, &p));
+  if (p[0] < 0xfd)
+  {
+    *out = p[0];
+    return 1;
+  }
+
+  size_t size = p[0] == 0xfd ? 2 : p[0] == 0xfe ? 4 : 8;
+  ELEMENTS_TRY(elements_read(r, size, &p));
+  uint64_t value = 0;
+  for (size_t i = 0; i < size; i++)
+  {
+    value |= (uint64_t)p[i] << (8 * i);
+  }
+  // reject non canonical encodings
+  if ((size == 2 && value < 0xfd) || (size == 4 && value <= 0xffff) || (size == 8 && value <= 0xffffffff))
+    return 0;
+  *out = value;
+  return 1;
+}
+
+static int elements_read_varbytes(elements_reader *r, const unsigned char **out, size_t *out_len)
+{
+  uint64_t n;
+  ELEMENTS_TRY(elements_read_varint(r, &n));
+  if (n > ELEMENTS_MAX_SIZE)
+    return 0;
+  ELEMENTS_TRY(elements_read(r, (size_t)n, out));
+  if (out_len != NULL)
+    *out_len = (size_t)n;
+  return 1;
+}
+
+static int elements_skip_stack(elements_reader *r)
+{
+  uint64_t n;
+  ELEMENTS_TRY(elements_read_varint(r, &n));
+  if (n > ELEMENTS_MAX_SIZE)
+    return 0;
+  for (uint64_t i = 0; i < n; i++)
+  {
+    ELEMENTS_TRY(elements_read_varbytes(r, NULL, NULL));
+  }
+  return 1;
+}
+
+// reads a confidential asset, value or nonce: a prefix byte followed by either
+// nothing (null), an explicit payload or a 32 bytes commitment. The returned
+// field includes the prefix.
+static int elements_read_confidential(elements_reader *r, size_t explicit_size, unsigned char prefix_a, unsigned char prefix_b, const unsigned char **out, size_t *out_len)
+{
+  const unsigned char *prefix;
+  ELEMENTS_TRY(elements_read(r, 1, &prefix));
+
+  size_t size;
+  if (prefix[0] == 0)
+    size = 0;
+  else if (prefix[0] == 1)
+    size = explicit_size;
+  else if (prefix[0] == prefix_a || prefix[0] == prefix_b)
+    size = 32;
+  else
+    return 0;
+
+  ELEMENTS_TRY(elements_read(r, size, NULL));
+  if (out != NULL)
+    *out = prefix;
+  if (out_len != NULL)
+    *out_len = size + 1;
+  return 1;
+}
+
+#define elements_read_asset(r, out, out_len) elements_read_confidential(r, 32, 0x0a, 0x0b, out, out_len)
+#define elements_read_value(r, out, out_len) elements_read_confidential(r, 8, 0x08, 0x09, out, out_len)
+#define elements_read_nonce(r, out, out_len) elements_read_confidential(r, 32, 0x02, 0x03, out, out_len)
+
+static int elements_skip_input(elements_reader *r)
+{
+  uint32_t prevout_index;
+  ELEMENTS_TRY(elements_read(r, 32, NULL));
+  ELEMENTS_TRY(elements_read_u32(r, &prevout_index));
+  ELEMENTS_TRY(elements_read_varbytes(r, NULL, NULL));
+  ELEMENTS_TRY(elements_read_u32(r, NULL));
+
+  if (prevout_index != 0xffffffff && (prevout_index & ELEMENTS_OUTPOINT_ISSUANCE_FLAG))
+  {
+    const unsigned char *amount, *inflation_keys;
+    size_t amount_len, inflation_keys_len;
+    // asset blinding nonce and asset entropy, then amount and inflation keys
+    ELEMENTS_TRY(elements_read(r, 64, NULL));
+    ELEMENTS_TRY(elements_read_value(r, &amount, &amount_len));
+    ELEMENTS_TRY(elements_read_value(r, &inflation_keys, &inflation_keys_len));
+    // the issuance rangeproofs would need the issued asset id, which is derived
+    // from the spent outpoint and the contract hash. Blinded issuances are not
+    // supported: reject them rather than accepting their proofs unchecked.
+    if (amount_len == 33 || inflation_keys_len == 33)
+      return 0;
+  }
+  return 1;
+}
+
+static int elements_read_output(elements_reader *r, elements_output *out)
+{
+  ELEMENTS_TRY(elements_read_asset(r, &out->asset, &out->asset_len));
+  ELEMENTS_TRY(elements_read_value(r, &out->value, &out->value_len));
+  ELEMENTS_TRY(elements_read_nonce(r, NULL, NULL));
+  return elements_read_varbytes(r, &out->script, &out->script_len);
+}
+
+enum
+{
+  ELEMENTS_SCAN_HEADER,
+  ELEMENTS_SCAN_INPUTS,
+  ELEMENTS_SCAN_N_OUTPUTS,
+  ELEMENTS_SCAN_OUTPUTS,
+  ELEMENTS_SCAN_LOCKTIME,
+  ELEMENTS_SCAN_INPUT_WITNESSES,
+  ELEMENTS_SCAN_OUTPUT_WITNESSES,
+  ELEMENTS_SCAN_DONE
+};
+
+// state of a transaction scan, so that a partially received transaction is
+// resumed from its last complete input, output or witness instead of being
+// rescanned from its first byte. Offsets are relative to the transaction start.
+typedef struct
+{
+  int phase;
+  // index of the next input, output or witness of the current phase
+  size_t i;
+  // offset following the last complete item
+  size_t pos;
+  elements_tx_layout layout;
+} elements_tx_scanner;
+
+static void elements_tx_scanner_init(elements_tx_scanner *s)
+{
+  memset(s, 0, sizeof(*s));
+}
+
+// reads the next item of the transaction. The scanner is only updated once
+// the whole item has been read.
+static int elements_scan_tx_step(elements_reader *r, elements_tx_scanner *s)
+{
+  elements_tx_layout *layout = &s->layout;
+  const unsigned char *flags;
+  uint64_t n;
+
+  switch (s->phase)
+  {
+  case ELEMENTS_SCAN_HEADER:
+    ELEMENTS_TRY(elements_read_u32(r, NULL));
+    ELEMENTS_TRY(elements_read(r, 1, &flags));
+    if (flags[0] > 1)
+      return 0;
+    ELEMENTS_TRY(elements_read_varint(r, &n));
+    if (n > ELEMENTS_MAX_SIZE)
+      return 0;
+    layout->has_witness = flags[0] & 1;
+    layout->n_inputs = (size_t)n;
+    s->phase = ELEMENTS_SCAN_INPUTS;
+    s->i = 0;
+    return 1;
+  case ELEMENTS_SCAN_INPUTS:
+    if (s->i == layout->n_inputs)
+    {
+      s->phase = ELEMENTS_SCAN_N_OUTPUTS;
+      return 1;
+    }
+    ELEMENTS_TRY(elements_skip_input(r));
+    s->i++;
+    return 1;
+  case ELEMENTS_SCAN_N_OUTPUTS:
+    ELEMENTS_TRY(elements_read_varint(r, &n));
+    if (n > ELEMENTS_MAX_SIZE)
+      return 0;
+    layout->n_outputs = (size_t)n;
+    layout->outputs_pos = r->pos;
+    s->phase = ELEMENTS_SCAN_OUTPUTS;
+    s->i = 0;
+    return 1;
+  case ELEMENTS_SCAN_OUTPUTS:
+    if (s->i == layout->n_outputs)
+    {
+      s->phase = ELEMENTS_SCAN_LOCKTIME;
+      return 1;
+    }
+    {
+      elements_output output;
+      ELEMENTS_TRY(elements_read_output(r, &output));
+    }
+    s->i++;
+    return 1;
+  case ELEMENTS_SCAN_LOCKTIME:
+    ELEMENTS_TRY(elements_read_u32(r, NULL));
+    if (!layout->has_witness)
+    {
+      layout->output_witnesses_pos = r->pos;
+      s->phase = ELEMENTS_SCAN_DONE;
+      return 1;
+    }
+    s->phase = ELEMENTS_SCAN_INPUT_WITNESSES;
+    s->i = 0;
+    return 1;
+  case ELEMENTS_SCAN_INPUT_WITNESSES:
+    if (s->i == layout->n_inputs)
+    {
+      layout->output_witnesses_pos = r->pos;
+      s->phase = ELEMENTS_SCAN_OUTPUT_WITNESSES;
+      s->i = 0;
+      return 1;
+    }
+    // issuance amount and inflation keys rangeproofs, only used by blinded
+    // issuances which elements_skip_input rejects, then script and pegin
+    // witnesses
+    ELEMENTS_TRY(elements_read_varbytes(r, NULL, NULL));
+    ELEMENTS_TRY(elements_read_varbytes(r, NULL, NULL));
+    ELEMENTS_TRY(elements_skip_stack(r));
+    ELEMENTS_TRY(elements_skip_stack(r));
+    s->i++;
+    return 1;
+  case ELEMENTS_SCAN_OUTPUT_WITNESSES:
+    if (s->i == layout->n_outputs)
+    {
+      s->phase = ELEMENTS_SCAN_DONE;
+      return 1;
+    }
+    // surjection proof and rangeproof
+    ELEMENTS_TRY(elements_read_varbytes(r, NULL, NULL));
+    ELEMENTS_TRY(elements_read_varbytes(r, NULL, NULL));
+    s->i++;
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+// walks a transaction without verifying anything, recording where its outputs
+// and output witnesses start. The reader must start at the transaction; on
+// ELEMENTS_NEED_MORE the scan can be resumed once more data is available.
+static int elements_scan_tx(elements_reader *r, elements_tx_scanner *s)
+{
+  r->pos = s->pos;
+  while (s->phase != ELEMENTS_SCAN_DONE)
+  {
+    int ret = elements_scan_tx_step(r, s);
+    if (ret != 1)
+    {
+      r->pos = s->pos;
+      return ret;
+    }
+    s->pos = r->pos;
+  }
+  return 1;
+}
+
+// verifies the proofs of a single output. The surjection proof is only checked
+// if input generators are given; an empty set fails on committed assets.
+static int elements_verify_output(
+  const secp256k1_context *ctx,
+  const elements_output *output,
+  const unsigned char *surjectionproof,
+  size_t surjectionproof_len,
+  const unsigned char *rangeproof,
+  size_t rangeproof_len,
+  const secp256k1_generator *input_generators,
+  size_t n_input_generators)
+{
+  // null assets and values are not allowed in a transaction output
+  if (output->asset_len == 1 || output->value_len == 1)
+    return 0;
+
+  secp256k1_generator gen;
+  if (output->asset[0] != 1)
+  {
+    if (!secp256k1_generator_parse(ctx, &gen, output->asset))
+      return 0;
+
+    if (input_generators != NULL)
+    {
+      secp256k1_surjectionproof proof;
+      if (n_input_generators == 0 || surjectionproof_len == 0 || !secp256k1_surjectionproof_parse(ctx, &proof, surjectionproof, surjectionproof_len))
+        return 0;
+      if (!secp256k1_surjectionproof_verify(ctx, &proof, input_generators, n_input_generators, &gen))
+        return 0;
+    }
+  }
+
+  // explicit amounts have nothing to prove
+  if (output->value[0] == 1)
+    return 1;
+
+  if (output->asset[0] == 1 && !secp256k1_generator_generate(ctx, &gen, output->asset + 1))
+    return 0;
+
+  secp256k1_pedersen_commitment commit;
+  uint64_t min_value, max_value;
+  if (rangeproof_len == 0 || !secp256k1_pedersen_commitment_parse(ctx, &commit, output->value))
+    return 0;
+  // Elements commits to the output script in the rangeproof
+  return secp256k1_rangeproof_verify(ctx, &min_value, &max_value, &commit, rangeproof, rangeproof_len, output->script, output->script_len, &gen);
+}
+
+// verifies every output of a transaction previously walked with elements_scan_tx
+static int elements_verify_outputs(
+  const secp256k1_context *ctx,
+  const unsigned char *data,
+  size_t len,
+  const elements_tx_layout *layout,
+  const secp256k1_generator *input_generators,
+  size_t n_input_generators)
+{
+  elements_reader outputs = {data, len, layout->outputs_pos};
+  elements_reader witnesses = {data, len, layout->output_witnesses_pos};
+
+  for (size_t i = 0; i < layout->n_outputs; i++)
+  {
+    elements_output output;
+    const unsigned char *surjectionproof = NULL;
+    const unsigned char *rangeproof = NULL;
+    size_t surjectionproof_len = 0;
+    size_t rangeproof_len = 0;
+
+    if (elements_read_output(&outputs, &output) != 1)
+      return 0;
+    if (layout->has_witness)
+    {
+      if (elements_read_varbytes(&witnesses, &surjectionproof, &surjectionproof_len) != 1 ||
+          elements_read_varbytes(&witnesses, &rangeproof, &rangeproof_len) != 1)
+        return 0;
+    }
+
+    if (!elements_verify_output(ctx, &output, surjectionproof, surjectionproof_len, rangeproof, rangeproof_len, input_generators, n_input_generators))
+      return 0;
+  }
+  return 1;
+}
+
+int elements_tx_verify(const unsigned char *tx, size_t tx_len, const unsigned char *const *input_generators_data, size_t n_input_generators)
+{
+  if (n_input_generators > SECP256K1_SURJECTIONPROOF_MAX_N_INPUTS)
+    return 0;
+
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_VERIFY);
+  // no generators are needed when every output asset is explicit, keep the
+  // array non-empty so that it is a valid VLA
+  secp256k1_generator input_generators[n_input_generators > 0 ? n_input_generators : 1];
+  for (size_t i = 0; i < n_input_generators; i++)
+  {
+    if (!secp256k1_generator_parse(ctx, &input_generators[i], input_generators_data[i]))
+    {
+      context_release(ctx);
+      return 0;
+    }
+  }
+
+  elements_reader r = {tx, tx_len, 0};
+  elements_tx_scanner scanner;
+  elements_tx_scanner_init(&scanner);
+  int ret = elements_scan_tx(&r, &scanner) == 1 && r.pos == tx_len;
+  if (ret == 1)
+  {
+    ret = elements_verify_outputs(ctx, tx, tx_len, &scanner.layout, input_generators, n_input_generators);
+  }
+
+  context_release(ctx);
   return ret;
 }
+
+static int elements_skip_dynafed_params(elements_reader *r)
+{
+  const unsigned char *type;
+  ELEMENTS_TRY(elements_read(r, 1, &type));
+  switch (type[0])
+  {
+  case 0:
+    return 1;
+  case 1:
+    // compact: signblockscript, signblock witness limit and elided root
+    ELEMENTS_TRY(elements_read_varbytes(r, NULL, NULL));
+    ELEMENTS_TRY(elements_read_u32(r, NULL));
+    return elements_read(r, 32, NULL);
+  case 2:
+    // full: signblockscript, signblock witness limit, fedpeg program,
+    // fedpegscript and extension space
+    ELEMENTS_TRY(elements_read_varbytes(r, NULL, NULL));
+    ELEMENTS_TRY(elements_read_u32(r, NULL));
+    ELEMENTS_TRY(elements_read_varbytes(r, NULL, NULL));
+    ELEMENTS_TRY(elements_read_varbytes(r, NULL, NULL));
+    return elements_skip_stack(r);
+  default:
+    return 0;
+  }
+}
+
+// block headers are parsed with Liquid's consensus parameters: signed blocks
+// with the height in the header
+static int elements_skip_block_header(elements_reader *r)
+{
+  uint32_t version;
+  ELEMENTS_TRY(elements_read_u32(r, &version));
+  // previous block hash, merkle root, time and height
+  ELEMENTS_TRY(elements_read(r, 32 + 32 + 4 + 4, NULL));
+
+  if (version & ELEMENTS_DYNAFED_VERSION_FLAG)
+  {
+    // current and proposed parameters, then the signblock witness
+    ELEMENTS_TRY(elements_skip_dynafed_params(r));
+    ELEMENTS_TRY(elements_skip_dynafed_params(r));
+    return elements_skip_stack(r);
+  }
+
+  // challenge and solution
+  ELEMENTS_TRY(elements_read_varbytes(r, NULL, NULL));
+  return elements_read_varbytes(r, NULL, NULL);
+}
+
+enum
+{
+  ELEMENTS_BLOCK_HEADER,
+  ELEMENTS_BLOCK_TX_COUNT,
+  ELEMENTS_BLOCK_TXS,
+  ELEMENTS_BLOCK_DONE,
+  ELEMENTS_BLOCK_INVALID
+};
+
+// Incremental block rangeproof verifier. Chunks are written in place with
+// elements_block_rangeproof_verifier_reserve and
+// elements_block_rangeproof_verifier_commit; each transaction is verified as
+// soon as it is complete and only the bytes of the transaction being received
+// stay buffered.
+// Only the rangeproofs are verified: surjection proofs need the assets of the
+// spent outputs, which a block doesn't carry. Use elements_tx_verify for those.
+typedef struct
+{
+  unsigned char *buf;
+  size_t len;
+  size_t cap;
+  int state;
+  uint64_t n_txs_left;
+  // scan of the transaction being received, which starts at buf
+  elements_tx_scanner scanner;
+} elements_block_rangeproof_verifier;
+
+elements_block_rangeproof_verifier *elements_block_rangeproof_verifier_create(void)
+{
+  elements_block_rangeproof_verifier *v = calloc(1, sizeof(elements_block_rangeproof_verifier));
+  if (v != NULL)
+    elements_tx_scanner_init(&v->scanner);
+  return v;
+}
+
+void elements_block_rangeproof_verifier_destroy(elements_block_rangeproof_verifier *v)
+{
+  if (v == NULL)
+    return;
+  free(v->buf);
+  free(v);
+}
+
+// returns a pointer where the next n bytes of the block can be written, NULL
+// if they can't be buffered
+unsigned char *elements_block_rangeproof_verifier_reserve(elements_block_rangeproof_verifier *v, size_t n)
+{
+  if (v->state == ELEMENTS_BLOCK_INVALID || n > ELEMENTS_MAX_SIZE - v->len)
+    return NULL;
+
+  if (v->len + n > v->cap)
+  {
+    size_t cap = v->cap == 0 ? 1024 : v->cap;
+    while (cap < v->len + n)
+    {
+      cap *= 2;
+    }
+    unsigned char *buf = realloc(v->buf, cap);
+    if (buf == NULL)
+      return NULL;
+    v->buf = buf;
+    v->cap = cap;
+  }
+  return v->buf + v->len;
+}
+
+static int elements_block_rangeproof_verifier_process(elements_block_rangeproof_verifier *v)
+{
+  secp256k1_context *ctx = context_acquire(SECP256K1_CONTEXT_VERIFY);
+  elements_reader r = {v->buf, v->len, 0};
+  int ret = 1;
+
+  while (ret == 1 && v->state != ELEMENTS_BLOCK_DONE)
+  {
+    size_t start = r.pos;
+    elements_reader tx;
+
+    switch (v->state)
+    {
+    case ELEMENTS_BLOCK_HEADER:
+      ret = elements_skip_block_header(&r);
+      if (ret == 1)
+        v->state = ELEMENTS_BLOCK_TX_COUNT;
+      break;
+    case ELEMENTS_BLOCK_TX_COUNT:
+      ret = elements_read_varint(&r, &v->n_txs_left);
+      if (ret == 1)
+        v->state = v->n_txs_left == 0 ? ELEMENTS_BLOCK_DONE : ELEMENTS_BLOCK_TXS;
+      break;
+    default:
+      // resumes the scan where the previous commit left it
+      tx.data = v->buf + start;
+      tx.len = v->len - start;
+      tx.pos = 0;
+      ret = elements_scan_tx(&tx, &v->scanner);
+      if (ret == 1)
+        ret = elements_verify_outputs(ctx, tx.data, tx.pos, &v->scanner.layout, NULL, 0);
+      if (ret == 1)
+      {
+        r.pos = start + tx.pos;
+        elements_tx_scanner_init(&v->scanner);
+        if (--v->n_txs_left == 0)
+          v->state = ELEMENTS_BLOCK_DONE;
+      }
+      break;
+    }
+
+    // incomplete items stay buffered until more data is committed
+    if (ret == ELEMENTS_NEED_MORE)
+      r.pos = start;
+  }
+
+  context_release(ctx);
+  if (ret == 0)
+  {
+    v->state = ELEMENTS_BLOCK_INVALID;
+    return 0;
+  }
+
+  memmove(v->buf, v->buf + r.pos, v->len - r.pos);
+  v->len -= r.pos;
+  return 1;
+}
+
+// consumes n bytes written at the pointer returned by
+// elements_block_rangeproof_verifier_reserve, returns 0 once the block is
+// invalid
+int elements_block_rangeproof_verifier_commit(elements_block_rangeproof_verifier *v, size_t n)
+{
+  if (v->state == ELEMENTS_BLOCK_INVALID || n > v->cap - v->len)
+    return 0;
+  v->len += n;
+  return elements_block_rangeproof_verifier_process(v);
+}
+
+// returns 1 if the whole block was received, with no trailing bytes, and all
+// its rangeproofs are valid. Surjection proofs are not checked.
+int elements_block_rangeproof_verifier_finish(const elements_block_rangeproof_verifier *v)
+{
+  return v->state == ELEMENTS_BLOCK_DONE && v->len == 0;
+}
@@ -0,0 +1,79 @@
+import anyTest, { TestInterface } from 'ava';
+
+import { CModule } from '../lib/cmodule';
+import { elements } from '../lib/elements';
+import { Secp256k1ZKP } from '../lib/interface';
+import { surjectionproof } from '../lib/surjectionproof';
+
+import fixtures from './fixtures/surjectionproof.json';
+
+// written by yarn compile:bounded with the default INITIAL_MEMORY, see
+// scripts/build_wasm
+const BOUNDED_ARTIFACT = '../lib/secp256k1-zkp-bounded.js';
+const INITIAL_MEMORY = 16777216;
+
+const test = anyTest as TestInterface<{
+  cModule: CModule;
+  lib: Pick<Secp256k1ZKP, 'elements' | 'surjectionproof'>;
+}>;
+
+test.before(async (t) => {
+  const { default: boundedLib } = await import(BOUNDED_ARTIFACT);
+  const cModule = (await boundedLib()) as CModule;
+  t.context = {
+    cModule,
+    lib: {
+      elements: elements(cModule),
+      surjectionproof: surjectionproof(cModule),
+    },
+  };
+});
+
+test('heap keeps its initial size after a large batch', (t) => {
+  const { cModule, lib } = t.context;
+
+  t.is(cModule.HEAPU8.length, INITIAL_MEMORY);
+
+  // every proof is verified with the shared preallocated context
+  const f = fixtures.verify[0];
+  const proof = new Uint8Array(Buffer.from(f.proof, 'hex'));
+  const ephemeralInputTags = f.ephemeralInputTags.map(
+    (v) => new Uint8Array(Buffer.from(v, 'hex'))
+  );
+  const ephemeralOutputTag = new Uint8Array(
+    Buffer.from(f.ephemeralOutputTag, 'hex')
+  );
+  for (let i = 0; i < 1000; i++) {
+    t.true(
+      lib.surjectionproof.verify(proof, ephemeralInputTags, ephemeralOutputTag)
+    );
+  }
+
+  // half of the heap is copied in and parsed at once
+  const tx = new Uint8Array(INITIAL_MEMORY / 2);
+  for (let i = 0; i < 4; i++) {
+    t.false(lib.elements.verifyTransaction(tx, ephemeralInputTags));
+  }
+
+  t.is(cModule.HEAPU8.length, INITIAL_MEMORY);
+});
+
+test('oversized batch throws without growing the heap', (t) => {
+  const { cModule, lib } = t.context;
+
+  const inputGenerators = [new Uint8Array(33)];
+  const oversized = new Uint8Array(INITIAL_MEMORY);
+
+  // allocated by Memory on the JS side
+  t.throws(() => lib.elements.verifyTransaction(oversized, inputGenerators), {
+    instanceOf: RangeError,
+  });
+  // allocated by the C verifier, malloc returns NULL instead of aborting
+  const verifier = lib.elements.blockRangeProofVerifier();
+  t.throws(() => verifier.update(oversized), { instanceOf: RangeError });
+
+  t.is(cModule.HEAPU8.length, INITIAL_MEMORY);
+  t.false(
+    lib.elements.verifyTransaction(new Uint8Array(1024), inputGenerators)
+  );
+});
@@ -0,0 +1,204 @@
+import anyTest, { TestInterface } from 'ava';
+
+import secp256k1 from '../index';
+import { Secp256k1ZKP } from '../lib/interface';
+
+import fixtures from './fixtures/elements.json';
+import surjectionFixtures from './fixtures/surjectionproof.json';
+
+const test = anyTest as TestInterface<{
+  lib: Secp256k1ZKP;
+  inputGenerators: Buffer[];
+  tx: Buffer;
+}>;
+
+function varInt(n: number): Buffer {
+  if (n < 0xfd) return Buffer.from([n]);
+  const buf = Buffer.alloc(3);
+  buf[0] = 0xfd;
+  buf.writeUInt16LE(n, 1);
+  return buf;
+}
+
+function varBytes(data: Uint8Array): Buffer {
+  return Buffer.concat([varInt(data.length), data]);
+}
+
+function uint32(n: number): Buffer {
+  const buf = Buffer.alloc(4);
+  buf.writeUInt32LE(n);
+  return buf;
+}
+
+// serializes a transaction with one input, one confidential output and an
+// explicit fee output
+function serializeTx(
+  assetCommitment: Uint8Array,
+  valueCommitment: Uint8Array,
+  script: Uint8Array,
+  surjectionProof: Uint8Array,
+  rangeProof: Uint8Array
+): Buffer {
+  const explicitAsset = Buffer.concat([Buffer.from([1]), Buffer.alloc(32, 1)]);
+  const explicitValue = Buffer.concat([Buffer.from([1]), Buffer.alloc(8, 0)]);
+  return Buffer.concat([
+    uint32(2),
+    Buffer.from([1]),
+    varInt(1),
+    Buffer.alloc(32, 7),
+    uint32(0),
+    varBytes(Buffer.alloc(0)),
+    uint32(0xffffffff),
+    varInt(2),
+    assetCommitment,
+    valueCommitment,
+    Buffer.from([0]),
+    varBytes(script),
+    explicitAsset,
+    explicitValue,
+    Buffer.from([0]),
+    varBytes(Buffer.alloc(0)),
+    uint32(0),
+    // input witness: issuance proofs, script witness and pegin witness
+    Buffer.from([0, 0, 0, 0]),
+    varBytes(surjectionProof),
+    varBytes(rangeProof),
+    Buffer.from([0, 0]),
+  ]);
+}
+
+test.before(async (t) => {
+  const lib = await secp256k1();
+  const f = surjectionFixtures.verify[0];
+  const assetCommitment = Buffer.from(f.ephemeralOutputTag, 'hex');
+  const blinder = Buffer.alloc(32, 3);
+  const script = Buffer.from(
+    '0014e1c5e5c2e1ea5de6b3f7a0b1f8ef53b8a7f9f0e1',
+    'hex'
+  );
+  const valueCommitment = lib.pedersen.commitment(
+    '10000',
+    assetCommitment,
+    blinder
+  );
+  const rangeProof = lib.rangeproof.sign(
+    '10000',
+    valueCommitment,
+    assetCommitment,
+    blinder,
+    Buffer.alloc(32, 4),
+    '1',
+    '0',
+    '0',
+    new Uint8Array(),
+    script
+  );
+
+  t.context = {
+    lib,
+    inputGenerators: f.ephemeralInputTags.map((g) => Buffer.from(g, 'hex')),
+    tx: serializeTx(
+      assetCommitment,
+      valueCommitment,
+      script,
+      Buffer.from(f.proof, 'hex'),
+      rangeProof
+    ),
+  };
+});
+
+test('verify transaction', (t) => {
+  const { lib, inputGenerators, tx } = t.context;
+
+  t.true(lib.elements.verifyTransaction(tx, inputGenerators));
+  t.false(lib.elements.verifyTransaction(tx.subarray(1), inputGenerators));
+  t.false(
+    lib.elements.verifyTransaction(
+      Buffer.concat([tx, Buffer.from([0])]),
+      inputGenerators
+    )
+  );
+  t.false(
+    lib.elements.verifyTransaction(tx, inputGenerators.slice().reverse())
+  );
+  // the confidential output needs the generators for its surjection proof
+  t.false(lib.elements.verifyTransaction(tx, []));
+
+  const tampered = Buffer.from(tx);
+  tampered[tampered.length - 10] ^= 1;
+  t.false(lib.elements.verifyTransaction(tampered, inputGenerators));
+});
+
+test('verify block rangeproofs in chunks', (t) => {
+  const { lib, tx } = t.context;
+
+  const header = Buffer.concat([
+    uint32(1),
+    Buffer.alloc(32 + 32 + 4 + 4),
+    varBytes(Buffer.from([0x51])),
+    varBytes(Buffer.alloc(0)),
+  ]);
+  const block = Buffer.concat([header, varInt(2), tx, tx]);
+
+  [1, 7, 1000, block.length].forEach((size) => {
+    const verifier = lib.elements.blockRangeProofVerifier();
+    for (let i = 0; i < block.length; i += size) {
+      t.true(verifier.update(block.subarray(i, i + size)));
+    }
+    t.true(verifier.finalize());
+    t.throws(() => verifier.update(block), {
+      message: 'block verifier already released',
+    });
+  });
+
+  const truncated = lib.elements.blockRangeProofVerifier();
+  truncated.update(block.subarray(0, block.length - 1));
+  t.false(truncated.finalize());
+
+  const tampered = Buffer.from(block);
+  tampered[tampered.length - 10] ^= 1;
+  const invalid = lib.elements.blockRangeProofVerifier();
+  t.false(invalid.update(tampered));
+  t.false(invalid.update(block));
+  t.false(invalid.finalize());
+
+  const destroyed = lib.elements.blockRangeProofVerifier();
+  destroyed.update(block.subarray(0, 10));
+  destroyed.destroy();
+  destroyed.destroy();
+  t.throws(() => destroyed.finalize(), {
+    message: 'block verifier already released',
+  });
+});
+
+test('verify transaction fixtures', (t) => {
+  const { lib, inputGenerators } = t.context;
+
+  fixtures.transactions.forEach((f) => {
+    const tx = Buffer.from(f.tx, 'hex');
+    t.is(
+      lib.elements.verifyTransaction(tx, inputGenerators),
+      f.expected,
+      f.description
+    );
+    // every fixture output has an explicit asset
+    t.is(lib.elements.verifyTransaction(tx, []), f.expected, f.description);
+  });
+});
+
+test('verify block fixtures', (t) => {
+  const { lib } = t.context;
+
+  fixtures.blocks.forEach((f) => {
+    const block = Buffer.from(f.block, 'hex');
+    [1, 64, block.length].forEach((size) => {
+      const verifier = lib.elements.blockRangeProofVerifier();
+      let valid = true;
+      for (let i = 0; i < block.length && valid; i += size) {
+        valid = verifier.update(block.subarray(i, i + size));
+      }
+      t.is(valid && verifier.finalize(), f.expected, f.description);
+      verifier.destroy();
+    });
+  });
+});
@@ -0,0 +1,12 @@
+import test from 'ava';
+
+import { loadSecp256k1ZKP } from '../lib/cmodule';
+import Memory from '../lib/memory';
+
+test('malloc throws when the heap cannot satisfy the request', async (t) => {
+  const cModule = await loadSecp256k1ZKP();
+  const memory = new Memory(cModule);
+
+  memory.malloc(32);
+  t.throws(() => memory.malloc(0x7fffffff), { instanceOf: RangeError });
+});
@@ -71,3 +71,22 @@ test('verify proof', (t) => {
     t.is(verify(proof, ephemeralInputTags, ephemeralOutputTag), f.expected);
   });
 });
+
+test('verify rejects input tags that would overflow the stack', (t) => {
+  const { verify } = t.context;
+
+  const f = fixtures.verify[0];
+  const proof = new Uint8Array(Buffer.from(f.proof, 'hex'));
+  const ephemeralInputTags = f.ephemeralInputTags.map(
+    (v) => new Uint8Array(Buffer.from(v, 'hex'))
+  );
+  const ephemeralOutputTag = new Uint8Array(
+    Buffer.from(f.ephemeralOutputTag, 'hex')
+  );
+
+  // the input generators are parsed into a stack array, more than 12 MiB of
+  // them would run past the wasm stack if the count wasn't checked first
+  const oversized = new Array(200000).fill(ephemeralInputTags[0]);
+  t.false(verify(proof, oversized, ephemeralOutputTag));
+  t.true(verify(proof, ephemeralInputTags, ephemeralOutputTag));
+});